@@ -13,6 +13,7 @@ BRUTEFORCE_EXE = "bruteforce.exe"
 DYNAMICFORWEIGHTS_EXE = "dynamicforweights.exe"
 DYNAMICFORPROFITS_EXE = "dynamicforprofits.exe"
 FPTAS_EXE = "fptas.exe"
+MINKNAP_EXE = "minknap.exe"
 
 subprocess.run("python generator.py")
 
@@ -31,7 +32,7 @@ for test_num in range(1, 21):
 	# Dynamic for weights
 	command = [f"{BUILD_DIR}{DYNAMICFORWEIGHTS_EXE} ", test_file]
 	start_time = time.time()
-	subprocess.run(command)
+	dynamicforweights_ans = subprocess.run(command).returncode
 	dynamicforweights_time = time.time() - start_time
 	print(f"Dynamic for weights ran in {dynamicforweights_time * 1000}ms.")
 	
@@ -49,4 +50,14 @@ for test_num in range(1, 21):
 	fptas_time = time.time() - start_time
 	print(f"FPTAS ran in {fptas_time * 1000}ms.")
 
+	# Expanding core, only if it was built
+	if os.path.isfile(f"{BUILD_DIR}{MINKNAP_EXE}"):
+		command = [f"{BUILD_DIR}{MINKNAP_EXE}", test_file]
+		start_time = time.time()
+		minknap_ans = subprocess.run(command).returncode
+		minknap_time = time.time() - start_time
+		print(f"Expanding core ran in {minknap_time * 1000}ms.")
+		if minknap_ans != dynamicforweights_ans:
+			print(f"Expanding core answered {minknap_ans}, dynamic for weights answered {dynamicforweights_ans}.")
+
 	print()
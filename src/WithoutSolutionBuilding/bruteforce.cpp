@@ -3,76 +3,36 @@
 // *****************************************************************************
 //
 // Brute force is solved quite intuitively. For each object we choose wether
-// to pick it or not. This of course gives us a complexity of 2^n. In order
-// to optimise this a bit and cut off the branches whenever we are sure that
-// they are going to lead to a fail we check for the weight if it has surpassed
-// the maximum weight.
+// to pick it or not. This of course gives us a complexity of 2^n.
 //
-// For a small number of objects this could be optimised into a dynamic on
-// configurations.
+// Objects heavier than G are dropped first, they can never be picked.
+//
+// When G is tight compared with the weights, a depth first search that cuts
+// every branch going over G only visits the few subsets that fit, and is used.
+// The same goes for 64 objects or more, which do not fit in a mask.
+//
+// Otherwise every subset is a bitmask and the masks are walked in Gray code
+// order. Two consecutive Gray codes differ in exactly one bit, the lowest set
+// bit of the step counter, so going to the next subset means adding or
+// removing a single object from the running weight and profit. The best subset
+// is kept as a mask and only turned into indices at the end. The mask space is
+// split on its top bits into one chunk per thread.
 //
 // Complexity:
-// Time - O(2^n)
-// Space - n : since it basically is a DFS 
+// Time - O(2^n), with O(1) work per subset for the Gray code walk
+// Space - n
 //
 // Cons:
-// This brute force is very sensitive to the maximum weight value. In this
-// approach we filter whenever the current weight surpasses the maximum weight.
-// Not to mention the insane exponantial time.
+// The time is still exponential. With a loose G the Gray code walk is about
+// 10 times faster than the pruned search on one core, but it still visits all
+// 2^n subsets. With a tight G only the pruning keeps it feasible at all.
 //
 // *****************************************************************************
 
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <cmath>
-using namespace std;
-
-struct Object {
-    long long weight;
-    long long profit;
-};
-
-int maxWeight;
-
-vector<Object> ReadData(char* fileName) {
-	ifstream fin(fileName);
-
-	int n;
-  fin >> n >> maxWeight;
-	vector<Object> objects(n);
-  for (int i = 0; i < n; i++) {
-    fin >> objects[i].weight;
-    fin >> objects[i].profit;
-  }
-
-	fin.close();
-	return objects;
-}
-
-long long RecursiveBruteForce(vector<Object>& objects, Object aggregate,
-		long long index) {
-	if (index >= objects.size()) {
-		return aggregate.profit;
-	}
-
-	Object newAggregate = {
-		aggregate.weight + objects[index].weight,
-		aggregate.profit + objects[index].profit
-	};
-
-	long long profit = INT64_MIN;
-	if (newAggregate.weight <= maxWeight) {
-		profit = RecursiveBruteForce(objects, newAggregate, index + 1);
-	}
-	return max(profit, RecursiveBruteForce(objects, aggregate, index + 1));
-}
-
-long long BruteForce(vector<Object>& objects) {
-	return RecursiveBruteForce(objects, {0, 0}, 0);
-}
+#include "../knapsack.h"
 
 int main(int argc, char** argv) {
 	vector<Object> objects = ReadData(argv[1]);
-	return BruteForce(objects);
+	vector<int> items;
+	return BruteForce<false>(N, G, objects, items, thread::hardware_concurrency());
 }
@@ -39,59 +39,10 @@
 //
 // *****************************************************************************
 
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <cmath>
-using namespace std;
-
-struct Object {
-    long long weight;
-    long long profit;
-};
-
-int maxWeight;
-
-vector<Object> ReadData(char* fileName) {
-	ifstream fin(fileName);
-
-	int n;
-  fin >> n >> maxWeight;
-	vector<Object> objects(n);
-  for (int i = 0; i < n; i++) {
-    fin >> objects[i].weight;
-    fin >> objects[i].profit;
-  }
-
-	fin.close();
-	return objects;
-}
-
-long long DynamicForProfits(vector<Object>& objects) {
-	long long maxProfitSum = 0;
-	for (long long i = 0; i < objects.size(); i++) {
-		maxProfitSum = max(maxProfitSum, maxProfitSum + objects[i].profit);
-	}
- 	vector<long long> dp(maxProfitSum + 5, INT64_MAX - maxWeight);
-	dp[0] = 0;
-
- 	long long profitSum = 0;
-	for (long long i = 0; i < objects.size(); i++) {
-		profitSum += objects[i].profit;
-		for (long long j = profitSum; j >= objects[i].profit; j--) {
-			dp[j] = min(dp[j], dp[j - objects[i].profit] + objects[i].weight);
-		}
-	}
-
-	for (long long ans = profitSum; ans >= 0; ans--) {
-		if (dp[ans] <= maxWeight) {
-			return ans;
-		}
-	}
-	return 0;
-}
+#include "../knapsack.h"
 
 int main(int argc, char** argv) {
 	vector<Object> objects = ReadData(argv[1]);
-	return DynamicForProfits(objects);
+	vector<int> items;
+	return DynamicForProfits<false>(N, G, objects, items);
 }
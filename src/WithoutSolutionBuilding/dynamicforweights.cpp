@@ -31,45 +31,10 @@
 //
 // *****************************************************************************
 
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <cmath>
-using namespace std;
-
-struct Object {
-    long long weight;
-    long long profit;
-};
-
-int maxWeight;
-
-vector<Object> ReadData(char* fileName) {
-	ifstream fin(fileName);
-
-	int n;
-  fin >> n >> maxWeight;
-	vector<Object> objects(n);
-  for (int i = 0; i < n; i++) {
-    fin >> objects[i].weight;
-    fin >> objects[i].profit;
-  }
-
-	fin.close();
-	return objects;
-}
-
-long long DynamicForWeights(vector<Object>& objects) {
- 	vector<long long> dp(maxWeight + 5, 0);
-	for (long long i = 0; i < objects.size(); i++) {
-		for (long long j = maxWeight; j >= objects[i].weight; j--) {
-			dp[j] = max(dp[j], dp[j - objects[i].weight] + objects[i].profit);
-		}
-	}
-	return dp[maxWeight];
-}
+#include "../knapsack.h"
 
 int main(int argc, char** argv) {
 	vector<Object> objects = ReadData(argv[1]);
-	return DynamicForWeights(objects);
+	vector<int> items;
+	return DynamicForWeights<false>(N, G, objects, items);
 }
@@ -25,6 +25,9 @@
 // The computed solution is correct within of factor of (1 - eps) of the best
 // solution.
 //
+// Objects heavier than G can never be picked, so they are left out of
+// biggestProfit, and n counts only the real objects.
+//
 // Complexity:
 // Time - O(n + n * maxProfit / K), where K = eps * biggestProfit / n, so the time
 // complexity becomes O(n + maxProfit / (eps * biggestProfit))
@@ -37,74 +40,10 @@
 //
 // *****************************************************************************
 
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <cmath>
-using namespace std;
-
-struct Object {
-    long long weight;
-    long long profit;
-};
-
-int maxWeight;
-
-vector<Object> ReadData(char* fileName) {
-	ifstream fin(fileName);
-
-	int n;
-  fin >> n >> maxWeight;
-	vector<Object> objects(n);
-  for (int i = 0; i < n; i++) {
-    fin >> objects[i].weight;
-    fin >> objects[i].profit;
-  }
-
-	fin.close();
-	return objects;
-}
-
-long long DynamicForProfits(vector<Object>& objects) {
-	long long maxProfitSum = 0;
-	for (long long i = 0; i < objects.size(); i++) {
-		maxProfitSum = max(maxProfitSum, maxProfitSum + objects[i].profit);
-	}
- 	vector<long long> dp(maxProfitSum + 5, INT64_MAX - maxWeight);
-	dp[0] = 0;
-
- 	long long profitSum = 0;
-	for (long long i = 0; i < objects.size(); i++) {
-		profitSum += objects[i].profit;
-		for (long long j = profitSum; j >= objects[i].profit; j--) {
-			dp[j] = min(dp[j], dp[j - objects[i].profit] + objects[i].weight);
-		}
-	}
-
-	for (long long ans = profitSum; ans >= 0; ans--) {
-		if (dp[ans] <= maxWeight) {
-			return ans;
-		}
-	}
-	return 0;
-}
-
-long long FPTAS(vector<Object>& objects, double eps) {
-	long long maxProfit = 0;
-	for (int i = 0; i < objects.size(); i++) {
-		maxProfit = max(maxProfit, objects[i].profit);
-	}
-	double scalingFactor = eps * maxProfit / objects.size();
-	vector<Object> scaledObjects(objects.size());
-	for (int i = 0; i < objects.size(); i++) {
-		scaledObjects[i] = {
-			objects[i].weight,
-			(long long)(objects[i].profit / scalingFactor)};
-	}
-	return (double)DynamicForProfits(scaledObjects) * scalingFactor;
-}
+#include "../knapsack.h"
 
 int main(int argc, char** argv) {
 	vector<Object> objects = ReadData(argv[1]);
-	return FPTAS(objects, 0.5);
+	vector<int> items;
+	return FPTAS<false>(N, G, objects, 0.5, items);
 }
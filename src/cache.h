@@ -0,0 +1,430 @@
+// *****************************************************************************
+// *                               Result Cache                                *
+// *****************************************************************************
+//
+// Remembers the results of solved instances, so an instance that comes back,
+// even with its objects in a different order, is not solved again.
+//
+// Canonical form:
+// The objects are sorted by (weight, profit). The key is a 128-bit MurmurHash3
+// digest of the sorted objects, G, the algorithm and, for FPTAS only, eps. The
+// answer does not depend on the order of the objects, so a permuted instance
+// has the same key. The chosen objects are stored as positions in the sorted
+// order and mapped back to the indices of whoever asks for them. Equal objects
+// are interchangeable, so it does not matter which of them a position lands on.
+//
+// Memory tier:
+// An LRU list of the most recent results, holding at most `capacityBytes`
+// bytes of entries. Every entry keeps its canonical objects, so a hash
+// collision is a miss and never a wrong answer. An entry bigger than the whole
+// tier is not kept.
+//
+// Disk tier (optional):
+// A memory-mapped file shared by every process that opens it. It holds an open
+// addressing table of DiskSlots followed by an append-only area for the chosen
+// positions. Slots are claimed with a compare and swap on their state and
+// published only once fully written, so readers in other processes never see
+// half of an entry. The objects themselves are not stored, so entries are
+// matched on the whole 128-bit digest: a wrong hit needs two different
+// instances with the same digest. That is very unlikely but not impossible.
+// Nothing is ever evicted from the disk tier: once its slots or its positions
+// area are full, new results are only kept in memory.
+//
+// Hits and misses are counted in Stats.
+//
+// *****************************************************************************
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "knapsack.h"
+
+const uint64_t DISK_CACHE_MAGIC = 0x4b4e41504341434bULL;
+const uint64_t MURMUR_C1 = 0x87c37b91114253d5ULL;
+const uint64_t MURMUR_C2 = 0x4cf5ad432745937fULL;
+const int DISK_PROBES = 32;
+
+enum DiskSlotState : uint64_t {
+	SLOT_EMPTY,
+	SLOT_WRITING,
+	SLOT_READY,
+	SLOT_DEAD,
+};
+
+struct Digest {
+	uint64_t low;
+	uint64_t high;
+};
+
+inline uint64_t Rotl64(uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t Fmix64(uint64_t k) {
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
+// MurmurHash3_x64_128 of the little endian bytes of words.
+inline Digest Murmur3(const vector<uint64_t>& words, uint64_t seed) {
+	uint64_t h1 = seed;
+	uint64_t h2 = seed;
+	size_t blocks = words.size() / 2;
+	for (size_t b = 0; b < blocks; b++) {
+		uint64_t k1 = words[2 * b];
+		uint64_t k2 = words[2 * b + 1];
+		k1 *= MURMUR_C1;
+		k1 = Rotl64(k1, 31);
+		k1 *= MURMUR_C2;
+		h1 ^= k1;
+		h1 = Rotl64(h1, 27);
+		h1 += h2;
+		h1 = h1 * 5 + 0x52dce729;
+		k2 *= MURMUR_C2;
+		k2 = Rotl64(k2, 33);
+		k2 *= MURMUR_C1;
+		h2 ^= k2;
+		h2 = Rotl64(h2, 31);
+		h2 += h1;
+		h2 = h2 * 5 + 0x38495ab5;
+	}
+	if (words.size() % 2 != 0) {
+		uint64_t k1 = words.back();
+		k1 *= MURMUR_C1;
+		k1 = Rotl64(k1, 31);
+		k1 *= MURMUR_C2;
+		h1 ^= k1;
+	}
+	h1 ^= words.size() * sizeof(uint64_t);
+	h2 ^= words.size() * sizeof(uint64_t);
+	h1 += h2;
+	h2 += h1;
+	h1 = Fmix64(h1);
+	h2 = Fmix64(h2);
+	h1 += h2;
+	h2 += h1;
+	return {h1, h2};
+}
+
+struct CanonicalInstance {
+	uint64_t key;
+	uint64_t check;
+	vector<Object> objects;
+	vector<long long> order;
+	vector<long long> position;
+};
+
+// Sorts the objects and hashes the result. order[k] is the original index of
+// the k-th sorted object, position[i] the sorted position of object i.
+inline CanonicalInstance Canonicalize(Algorithm algorithm, long long n,
+		long long g, const vector<Object>& objects, double eps) {
+	CanonicalInstance canonical;
+	canonical.order.resize(n);
+	for (long long k = 0; k < n; k++) {
+		canonical.order[k] = k + 1;
+	}
+	sort(canonical.order.begin(), canonical.order.end(), [&](long long a, long long b) {
+		if (objects[a].weight != objects[b].weight) {
+			return objects[a].weight < objects[b].weight;
+		}
+		return objects[a].profit < objects[b].profit;
+	});
+
+	canonical.objects.resize(n);
+	canonical.position.resize(n + 1);
+	for (long long k = 0; k < n; k++) {
+		canonical.objects[k] = objects[canonical.order[k]];
+		canonical.position[canonical.order[k]] = k;
+	}
+
+	uint64_t epsBits = 0;
+	if (algorithm == Algorithm::FPTAS) {
+		memcpy(&epsBits, &eps, sizeof(eps));
+	}
+	vector<uint64_t> words = {(uint64_t)algorithm, epsBits, (uint64_t)g, (uint64_t)n};
+	words.reserve(4 + 2 * n);
+	for (const Object& object : canonical.objects) {
+		words.push_back(object.weight);
+		words.push_back(object.profit);
+	}
+	Digest digest = Murmur3(words, 0);
+	canonical.key = digest.low;
+	canonical.check = digest.high;
+	return canonical;
+}
+
+struct DiskHeader {
+	uint64_t magic;
+	uint64_t slotCount;
+	uint64_t positionCount;
+	uint64_t positionsUsed;
+};
+
+struct DiskSlot {
+	uint64_t state;
+	uint64_t key;
+	uint64_t check;
+	int64_t profit;
+	uint64_t offset;
+	uint64_t count;
+};
+
+struct DiskCache {
+	int fd = -1;
+	size_t size = 0;
+	DiskHeader* header = nullptr;
+	DiskSlot* slots = nullptr;
+	int32_t* positions = nullptr;
+
+	DiskCache() = default;
+	DiskCache(const DiskCache&) = delete;
+	DiskCache& operator=(const DiskCache&) = delete;
+
+	// Maps the file, creating it if needed. A file created with other sizes
+	// is used with the sizes it was created with. The file is sized and its
+	// header written under an exclusive flock, which the kernel drops if the
+	// process dies, so a crash halfway through only leaves the file to be
+	// initialized again by the next process.
+	bool Open(const string& path, uint64_t slotCount, uint64_t positionCount) {
+		fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd < 0 || flock(fd, LOCK_EX) != 0) {
+			Close();
+			return false;
+		}
+		struct stat info;
+		size = sizeof(DiskHeader) + slotCount * sizeof(DiskSlot) +
+				positionCount * sizeof(int32_t);
+		if (fstat(fd, &info) != 0 ||
+				((size_t)info.st_size < size && ftruncate(fd, size) != 0)) {
+			Close();
+			return false;
+		}
+		size = max(size, (size_t)info.st_size);
+		void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (base == MAP_FAILED) {
+			Close();
+			return false;
+		}
+		header = (DiskHeader*)base;
+
+		if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != DISK_CACHE_MAGIC) {
+			header->slotCount = slotCount;
+			header->positionCount = positionCount;
+			header->positionsUsed = 0;
+			__atomic_store_n(&header->magic, DISK_CACHE_MAGIC, __ATOMIC_RELEASE);
+		}
+		flock(fd, LOCK_UN);
+		if (sizeof(DiskHeader) +
+				header->slotCount * sizeof(DiskSlot) +
+				header->positionCount * sizeof(int32_t) > size) {
+			Close();
+			return false;
+		}
+		slots = (DiskSlot*)(header + 1);
+		positions = (int32_t*)(slots + header->slotCount);
+		return true;
+	}
+
+	void Close() {
+		if (header != nullptr) {
+			munmap(header, size);
+		}
+		if (fd >= 0) {
+			close(fd);
+		}
+		fd = -1;
+		header = nullptr;
+		slots = nullptr;
+		positions = nullptr;
+	}
+
+	~DiskCache() {
+		Close();
+	}
+
+	bool Lookup(uint64_t key, uint64_t check, long long& profit, vector<int>& out) {
+		for (int p = 0; p < DISK_PROBES; p++) {
+			DiskSlot& slot = slots[(key + p) % header->slotCount];
+			uint64_t state = __atomic_load_n(&slot.state, __ATOMIC_ACQUIRE);
+			if (state == SLOT_EMPTY) {
+				return false;
+			}
+			if (state == SLOT_READY && slot.key == key && slot.check == check) {
+				profit = slot.profit;
+				out.assign(positions + slot.offset, positions + slot.offset + slot.count);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Claims a free slot first and only then takes positions for it, so a
+	// result that finds no slot does not use up any positions. A claimed slot
+	// whose positions do not fit is marked dead and can be claimed again.
+	void Insert(uint64_t key, uint64_t check, long long profit, const vector<int>& in) {
+		for (int p = 0; p < DISK_PROBES; p++) {
+			DiskSlot& slot = slots[(key + p) % header->slotCount];
+			uint64_t expected = __atomic_load_n(&slot.state, __ATOMIC_ACQUIRE);
+			if (expected == SLOT_READY && slot.key == key && slot.check == check) {
+				return;
+			}
+			if ((expected == SLOT_EMPTY || expected == SLOT_DEAD) &&
+					__atomic_compare_exchange_n(&slot.state, &expected, SLOT_WRITING,
+					false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+				uint64_t offset;
+				if (!ReservePositions(in.size(), offset)) {
+					__atomic_store_n(&slot.state, SLOT_DEAD, __ATOMIC_RELEASE);
+					return;
+				}
+				copy(in.begin(), in.end(), positions + offset);
+				slot.key = key;
+				slot.check = check;
+				slot.profit = profit;
+				slot.offset = offset;
+				slot.count = in.size();
+				__atomic_store_n(&slot.state, SLOT_READY, __ATOMIC_RELEASE);
+				return;
+			}
+		}
+	}
+
+	// Takes count positions from the positions area, only if they all fit.
+	bool ReservePositions(uint64_t count, uint64_t& offset) {
+		offset = __atomic_load_n(&header->positionsUsed, __ATOMIC_ACQUIRE);
+		do {
+			if (offset + count > header->positionCount) {
+				return false;
+			}
+		} while (!__atomic_compare_exchange_n(&header->positionsUsed, &offset,
+				offset + count, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+		return true;
+	}
+};
+
+struct CacheEntry {
+	uint64_t key;
+	Algorithm algorithm;
+	long long g;
+	double eps;
+	vector<Object> objects;
+	long long profit;
+	vector<int> positions;
+};
+
+// What an entry costs in memory, including its list and index nodes.
+inline size_t EntryBytes(const CacheEntry& entry) {
+	return sizeof(CacheEntry) + 64 + entry.objects.size() * sizeof(Object) +
+			entry.positions.size() * sizeof(int);
+}
+
+struct ResultCache {
+	size_t capacityBytes;
+	size_t usedBytes = 0;
+	list<CacheEntry> entries;
+	unordered_map<uint64_t, list<CacheEntry>::iterator> index;
+	DiskCache disk;
+	bool useDisk = false;
+
+	// An empty diskPath keeps the cache in memory only.
+	ResultCache(size_t capacityBytes, const string& diskPath = "",
+			uint64_t diskSlots = 1 << 16, uint64_t diskPositions = 1 << 24)
+			: capacityBytes(capacityBytes) {
+		if (!diskPath.empty()) {
+			useDisk = disk.Open(diskPath, diskSlots, diskPositions);
+		}
+	}
+
+	// Same as Solve<true>, with out sorted by index.
+	long long Solve(Algorithm algorithm, long long n, long long g,
+			const vector<Object>& objects, double eps, vector<int>& out) {
+		if (algorithm != Algorithm::FPTAS) {
+			eps = 0;
+		}
+		CanonicalInstance canonical = Canonicalize(algorithm, n, g, objects, eps);
+
+		long long profit;
+		vector<int> positions;
+		auto it = index.find(canonical.key);
+		if (it != index.end() && it->second->algorithm == algorithm &&
+				it->second->g == g && it->second->eps == eps &&
+				SameObjects(it->second->objects, canonical.objects)) {
+			entries.splice(entries.begin(), entries, it->second);
+			Stats.cacheHits++;
+			profit = it->second->profit;
+			positions = it->second->positions;
+		} else if (useDisk && disk.Lookup(canonical.key, canonical.check, profit, positions)) {
+			Stats.diskHits++;
+			Remember(canonical, algorithm, g, eps, profit, positions);
+		} else {
+			Stats.cacheMisses++;
+			vector<int> items;
+			profit = ::Solve<true>(algorithm, n, g, objects, eps, items);
+			for (int item : items) {
+				positions.push_back(canonical.position[item + 1]);
+			}
+			sort(positions.begin(), positions.end());
+			Remember(canonical, algorithm, g, eps, profit, positions);
+			if (useDisk) {
+				disk.Insert(canonical.key, canonical.check, profit, positions);
+			}
+		}
+
+		out.clear();
+		for (int position : positions) {
+			out.push_back(canonical.order[position] - 1);
+		}
+		sort(out.begin(), out.end());
+		return profit;
+	}
+
+	static bool SameObjects(const vector<Object>& a, const vector<Object>& b) {
+		if (a.size() != b.size()) {
+			return false;
+		}
+		for (size_t k = 0; k < a.size(); k++) {
+			if (a[k].weight != b[k].weight || a[k].profit != b[k].profit) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Remember(CanonicalInstance& canonical, Algorithm algorithm, long long g,
+			double eps, long long profit, const vector<int>& positions) {
+		auto it = index.find(canonical.key);
+		if (it != index.end()) {
+			Forget(it->second);
+		}
+		CacheEntry entry = {canonical.key, algorithm, g, eps,
+				move(canonical.objects), profit, positions};
+		if (EntryBytes(entry) > capacityBytes) {
+			return;
+		}
+		usedBytes += EntryBytes(entry);
+		entries.push_front(move(entry));
+		index[canonical.key] = entries.begin();
+		while (usedBytes > capacityBytes) {
+			Forget(prev(entries.end()));
+		}
+	}
+
+	void Forget(list<CacheEntry>::iterator entry) {
+		usedBytes -= EntryBytes(*entry);
+		index.erase(entry->key);
+		entries.erase(entry);
+	}
+};
+
+#endif // CACHE_H
@@ -0,0 +1,43 @@
+// *****************************************************************************
+// *                              Cached solving                               *
+// *****************************************************************************
+//
+// Solves every given test with the same algorithm through one ResultCache.
+// Tests that are identical, or the same objects in another order, are only
+// solved once. With a cache file, a test solved by another process is not
+// solved again either. See cache.h.
+//
+// Usage: cached.exe <algorithm> <eps> <cache file | -> <test>...
+// where algorithm is the name of one of the other executables, e.g. fptas.
+//
+// The hit and miss counters are printed at the end, and the answer of the last
+// test is returned.
+//
+// *****************************************************************************
+
+#include <iostream>
+#include <stdlib.h>
+#include "knapsack.h"
+#include "cache.h"
+
+const size_t CACHED_MEMORY_BYTES = (size_t)256 << 20;
+
+int main(int argc, char** argv) {
+	Algorithm algorithm;
+	if (argc < 5 || !ParseAlgorithm(argv[1], algorithm)) {
+		cerr << "Usage: " << argv[0] << " <algorithm> <eps> <cache file | -> <test>...\n";
+		return -1;
+	}
+	string diskPath = argv[3];
+	ResultCache cache(CACHED_MEMORY_BYTES, diskPath == "-" ? "" : diskPath);
+
+	long long ans = 0;
+	for (int t = 4; t < argc; t++) {
+		vector<Object> objects = ReadData(argv[t]);
+		vector<int> items;
+		ans = cache.Solve(algorithm, N, G, objects, atof(argv[2]), items);
+	}
+	cout << "Cache hits: " << Stats.cacheHits << ", disk hits: " << Stats.diskHits
+			<< ", misses: " << Stats.cacheMisses << "\n";
+	return ans;
+}
@@ -0,0 +1,104 @@
+// *****************************************************************************
+// *                       Distributed dynamic programming                     *
+// *****************************************************************************
+//
+// Runs DynamicForWeights or DynamicForProfits sharded over several worker
+// processes, see distributed.h.
+//
+// Usage:
+// distributed.exe coordinate <address> <test> <weights|profits> <workers>
+// distributed.exe work <coordinator address> <listen address>
+// distributed.exe local <test> <weights|profits> <workers> [unix|tcp]
+//
+// `local` forks the workers on this machine, talking over unix sockets in /tmp
+// or over tcp on 127.0.0.1, so the whole protocol can be tried on one box.
+//
+// The coordinator returns the answer, as every other solver does.
+//
+// Complexity:
+// Time - O(n * width / workers) per worker, plus sending sum(w) cells along
+// the chain, where width is G or maxProfit
+// Space - O(width / workers) cells and O(n * width / workers) bits per worker
+//
+// Cons:
+// Every object costs one message per worker, so objects with a tiny shift are
+// dominated by latency. The workers form a chain, so the last one starts
+// (workers - 1) objects after the first.
+//
+// *****************************************************************************
+
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include "knapsack.h"
+#include "distributed.h"
+
+int Usage(char* name) {
+	cerr << "Usage:\n"
+			<< name << " coordinate <address> <test> <weights|profits> <workers>\n"
+			<< name << " work <coordinator address> <listen address>\n"
+			<< name << " local <test> <weights|profits> <workers> [unix|tcp]\n";
+	return -1;
+}
+
+// Reads a worker count, which has to be a positive number.
+bool ParseWorkers(const char* text, long long& workers) {
+	char* end;
+	workers = strtoll(text, &end, 10);
+	return *text != '\0' && *end == '\0' && workers > 0;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		return Usage(argv[0]);
+	}
+	string mode = argv[1];
+
+	if (mode == "work" && argc == 4) {
+		RunWorker(argv[2], argv[3]);
+		return 0;
+	}
+
+	long long workers;
+	if (mode == "coordinate" && argc == 6 && ParseWorkers(argv[5], workers)) {
+		vector<Object> objects = ReadData(argv[3]);
+		DistributedAxis axis = string(argv[4]) == "profits" ? PROFITS_AXIS : WEIGHTS_AXIS;
+		string bound;
+		int listener = Listen(argv[2], bound);
+		cerr << "Coordinator listening on " << bound << "\n";
+		vector<int> items;
+		long long ans = Coordinate(listener, workers, axis, N, G, objects, items);
+		StopListening(listener, bound);
+		return ans;
+	}
+
+	if (mode == "local" && (argc == 5 || argc == 6) && ParseWorkers(argv[4], workers)) {
+		vector<Object> objects = ReadData(argv[2]);
+		DistributedAxis axis = string(argv[3]) == "profits" ? PROFITS_AXIS : WEIGHTS_AXIS;
+		bool tcp = argc == 6 && string(argv[5]) == "tcp";
+		string prefix = "unix:/tmp/knapsack-" + to_string(getpid());
+
+		string bound;
+		int listener = Listen(tcp ? "tcp:127.0.0.1:0" : prefix + "-coordinator.sock", bound);
+		vector<pid_t> children;
+		for (long long k = 0; k < workers; k++) {
+			pid_t child = fork();
+			if (child == 0) {
+				close(listener);
+				RunWorker(bound, tcp ? "tcp:127.0.0.1:0" : prefix + "-" + to_string(k) + ".sock");
+				_exit(0);
+			}
+			children.push_back(child);
+		}
+
+		vector<int> items;
+		long long ans = Coordinate(listener, workers, axis, N, G, objects, items);
+		StopListening(listener, bound);
+		for (pid_t child : children) {
+			waitpid(child, nullptr, 0);
+		}
+		return ans;
+	}
+
+	return Usage(argv[0]);
+}
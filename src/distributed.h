@@ -0,0 +1,519 @@
+// *****************************************************************************
+// *                         Distributed dynamic                               *
+// *****************************************************************************
+//
+// DynamicForWeights or DynamicForProfits split over several worker processes.
+// The axis of the row (weights 0..G or profits 0..maxProfitSum) is cut into
+// equal shards, one per worker, and every worker only keeps its own shard of
+// the row and of the decision bits.
+//
+// Halo exchange:
+// For an object that shifts the row by w (its weight, or its profit), worker
+// k needs the old values of the w columns right before its shard. Worker k - 1
+// has exactly those, either in its own shard or in the halo it got itself, so
+// every worker receives a w wide halo from its left neighbour and passes the
+// last w columns of (halo + shard) on to its right neighbour. Data only flows
+// to the right, so the workers form a pipeline and the leftmost one can already
+// be several objects ahead.
+//
+// A halo can be as wide as everything left of the shard, so it is never held
+// whole. Its columns travel from the highest to the lowest, HALO_CHUNK cells
+// at a time. A worker first forwards its columns to the right, then sweeps its
+// shard from the top down, which reads the rest of the halo in the same order.
+// The halo columns a worker forwards are never read by its own sweep, so every
+// column is read from the socket exactly once.
+//
+// Building the solution:
+// Every worker sends the coordinator its best column. The coordinator picks
+// the answer column and sends it to everyone. The worker owning it walks the
+// objects backwards from n using its decision bits until the column leaves its
+// shard, then hands (object, column) to its left neighbour, and so on. Every
+// worker finally sends the objects it found to the coordinator.
+//
+// Setup:
+// The coordinator listens on an address, every worker listens on its own and
+// registers it with the coordinator. Ranks are given in registration order.
+// The coordinator sends each worker its rank, the instance and the address of
+// its left neighbour, and the workers connect to their left neighbours.
+//
+// Addresses are "unix:<path>" or "tcp:<host>:<port>". A tcp port of 0 picks a
+// free one, which is then registered.
+//
+// Cells are always 64 bit here, the row is what gets sharded.
+//
+// *****************************************************************************
+
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "knapsack.h"
+
+const size_t HALO_CHUNK = 1 << 16;
+
+enum DistributedAxis : uint64_t {
+	WEIGHTS_AXIS,
+	PROFITS_AXIS,
+};
+
+struct DistributedSetup {
+	uint64_t rank;
+	uint64_t count;
+	uint64_t axis;
+	int64_t n;
+	int64_t g;
+	int64_t width;
+};
+
+struct HaloToken {
+	int64_t item;
+	int64_t column;
+};
+
+struct ColumnCandidate {
+	int64_t column;
+	int64_t value;
+};
+
+inline void SocketFail(const string& what) {
+	perror(what.c_str());
+	exit(EXIT_FAILURE);
+}
+
+// Splits "tcp:<host>:<port>" into host and port.
+inline void SplitTcpAddress(const string& address, string& host, string& port) {
+	size_t colon = address.rfind(':');
+	if (colon == string::npos || colon < 4) {
+		fprintf(stderr, "Bad address %s\n", address.c_str());
+		exit(EXIT_FAILURE);
+	}
+	host = address.substr(4, colon - 4);
+	port = address.substr(colon + 1);
+}
+
+inline addrinfo* ResolveTcp(const string& host, const string& port) {
+	addrinfo hints = {};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* result;
+	if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) {
+		fprintf(stderr, "Can not resolve %s:%s\n", host.c_str(), port.c_str());
+		exit(EXIT_FAILURE);
+	}
+	return result;
+}
+
+// Listens on address and stores in bound the address peers should connect to.
+inline int Listen(const string& address, string& bound) {
+	int fd;
+	if (address.rfind("unix:", 0) == 0) {
+		string path = address.substr(5);
+		sockaddr_un local = {};
+		local.sun_family = AF_UNIX;
+		strncpy(local.sun_path, path.c_str(), sizeof(local.sun_path) - 1);
+		unlink(path.c_str());
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0 || bind(fd, (sockaddr*)&local, sizeof(local)) != 0) {
+			SocketFail(address);
+		}
+		bound = address;
+	} else {
+		string host, port;
+		SplitTcpAddress(address, host, port);
+		addrinfo* local = ResolveTcp(host, port);
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (fd < 0) {
+			SocketFail(address);
+		}
+		int reuse = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		if (bind(fd, local->ai_addr, local->ai_addrlen) != 0) {
+			SocketFail(address);
+		}
+		freeaddrinfo(local);
+		sockaddr_in actual;
+		socklen_t length = sizeof(actual);
+		getsockname(fd, (sockaddr*)&actual, &length);
+		bound = "tcp:" + host + ":" + to_string(ntohs(actual.sin_port));
+	}
+	if (listen(fd, 128) != 0) {
+		SocketFail(address);
+	}
+	return fd;
+}
+
+inline void StopListening(int fd, const string& bound) {
+	close(fd);
+	if (bound.rfind("unix:", 0) == 0) {
+		unlink(bound.substr(5).c_str());
+	}
+}
+
+inline int Connect(const string& address) {
+	int fd;
+	if (address.rfind("unix:", 0) == 0) {
+		sockaddr_un remote = {};
+		remote.sun_family = AF_UNIX;
+		strncpy(remote.sun_path, address.substr(5).c_str(), sizeof(remote.sun_path) - 1);
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0 || connect(fd, (sockaddr*)&remote, sizeof(remote)) != 0) {
+			SocketFail(address);
+		}
+	} else {
+		string host, port;
+		SplitTcpAddress(address, host, port);
+		addrinfo* remote = ResolveTcp(host, port);
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (fd < 0 || connect(fd, remote->ai_addr, remote->ai_addrlen) != 0) {
+			SocketFail(address);
+		}
+		freeaddrinfo(remote);
+		int noDelay = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+	}
+	return fd;
+}
+
+// Accepts a peer. Tcp peers get TCP_NODELAY like the ones from Connect, since
+// the halos of the chain travel over accepted sockets too.
+inline int Accept(int listener) {
+	sockaddr_storage peer;
+	socklen_t length = sizeof(peer);
+	int fd = accept(listener, (sockaddr*)&peer, &length);
+	if (fd < 0) {
+		SocketFail("accept");
+	}
+	if (peer.ss_family == AF_INET) {
+		int noDelay = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+	}
+	return fd;
+}
+
+inline void SendAll(int fd, const void* data, size_t size) {
+	const char* bytes = (const char*)data;
+	while (size > 0) {
+		ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+		if (sent <= 0) {
+			SocketFail("send");
+		}
+		bytes += sent;
+		size -= sent;
+	}
+}
+
+inline void RecvAll(int fd, void* data, size_t size) {
+	char* bytes = (char*)data;
+	while (size > 0) {
+		ssize_t received = recv(fd, bytes, size, 0);
+		if (received <= 0) {
+			SocketFail("recv");
+		}
+		bytes += received;
+		size -= received;
+	}
+}
+
+template <typename T>
+void SendValue(int fd, const T& value) {
+	SendAll(fd, &value, sizeof(T));
+}
+
+template <typename T>
+T RecvValue(int fd) {
+	T value;
+	RecvAll(fd, &value, sizeof(T));
+	return value;
+}
+
+template <typename T>
+void SendVector(int fd, const vector<T>& values) {
+	SendValue<uint64_t>(fd, values.size());
+	SendAll(fd, values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+vector<T> RecvVector(int fd) {
+	vector<T> values(RecvValue<uint64_t>(fd));
+	RecvAll(fd, values.data(), values.size() * sizeof(T));
+	return values;
+}
+
+inline void SendString(int fd, const string& text) {
+	SendVector(fd, vector<char>(text.begin(), text.end()));
+}
+
+inline string RecvString(int fd) {
+	vector<char> text = RecvVector<char>(fd);
+	return string(text.begin(), text.end());
+}
+
+// Reads the count columns of a halo from fd, highest first.
+struct HaloReader {
+	int fd;
+	long long remaining = 0;
+	vector<long long> chunk;
+	size_t next = 0;
+
+	HaloReader(int fd) : fd(fd) {}
+
+	void Start(long long count) {
+		remaining = count;
+		chunk.clear();
+		next = 0;
+	}
+
+	// Returns the next columns, highest first, and stores how many of them
+	// there are, at most count, in got.
+	const long long* Take(long long count, long long& got) {
+		if (next == chunk.size()) {
+			chunk.resize(min<long long>(remaining, HALO_CHUNK));
+			RecvAll(fd, chunk.data(), chunk.size() * sizeof(long long));
+			remaining -= chunk.size();
+			next = 0;
+		}
+		got = min<long long>(count, chunk.size() - next);
+		next += got;
+		return chunk.data() + next - got;
+	}
+};
+
+// Sends halo columns to fd, highest first.
+struct HaloWriter {
+	int fd;
+	vector<long long> chunk;
+
+	HaloWriter(int fd) : fd(fd) {}
+
+	// Sends values, which are already highest first.
+	void Append(const long long* values, long long count) {
+		while (count > 0) {
+			long long piece = min<long long>(count, HALO_CHUNK - chunk.size());
+			chunk.insert(chunk.end(), values, values + piece);
+			values += piece;
+			count -= piece;
+			if (chunk.size() == HALO_CHUNK) {
+				Flush();
+			}
+		}
+	}
+
+	// Sends the row values[0..count), highest column first.
+	void AppendRow(const long long* values, long long count) {
+		while (count > 0) {
+			long long piece = min<long long>(count, HALO_CHUNK - chunk.size());
+			chunk.insert(chunk.end(), make_reverse_iterator(values + count),
+					make_reverse_iterator(values + count - piece));
+			count -= piece;
+			if (chunk.size() == HALO_CHUNK) {
+				Flush();
+			}
+		}
+	}
+
+	void Flush() {
+		if (!chunk.empty()) {
+			SendAll(fd, chunk.data(), chunk.size() * sizeof(long long));
+			chunk.clear();
+		}
+	}
+};
+
+// The columns [lo, hi) of the row that belong to rank.
+inline pair<long long, long long> Shard(long long width, long long count,
+		long long rank) {
+	return {width * rank / count, width * (rank + 1) / count};
+}
+
+// One worker's share of the dynamic. On the weights axis the cells are
+// profits and are maximised, on the profits axis they are weights and are
+// minimised, with g + 1 as infinity.
+template <DistributedAxis Axis>
+void DistributedWorkerKernel(const DistributedSetup& setup,
+		const vector<Object>& objects, int coordinator, int left, int right) {
+	auto [lo, hi] = Shard(setup.width, setup.count, setup.rank);
+	long long n = setup.n;
+	long long g = setup.g;
+	auto shiftOf = [&](long long i) {
+		return Axis == WEIGHTS_AXIS ? objects[i].weight : objects[i].profit;
+	};
+	auto gainOf = [&](long long i) {
+		return Axis == WEIGHTS_AXIS ? objects[i].profit : objects[i].weight;
+	};
+
+	vector<long long> dp(hi - lo, Axis == WEIGHTS_AXIS ? 0 : g + 1);
+	if (Axis == PROFITS_AXIS && lo == 0 && hi > 0) {
+		dp[0] = 0;
+	}
+	DecisionBits taken(n + 1, hi - lo);
+	HaloReader incoming(left);
+	HaloWriter outgoing(right);
+
+	for (long long i = 1; i <= n; i++) {
+		if (objects[i].weight > g) {
+			continue;
+		}
+		long long shift = shiftOf(i);
+		long long gain = gainOf(i);
+
+		// The halo is the old columns [lo - min(shift, lo), lo). The ones from
+		// bottom up are only forwarded, the sweep reads the ones below.
+		incoming.Start(min(shift, lo));
+		long long bottom = hi - min(shift, hi);
+		if (right >= 0 && hi > max(lo, bottom)) {
+			outgoing.AppendRow(dp.data() + max(lo, bottom) - lo, hi - max(lo, bottom));
+		}
+		for (long long count = lo - bottom; count > 0; ) {
+			long long got;
+			const long long* values = incoming.Take(count, got);
+			if (right >= 0) {
+				outgoing.Append(values, got);
+			}
+			count -= got;
+		}
+		outgoing.Flush();
+
+		auto relax = [&](long long j, long long candidate) {
+			if (Axis == WEIGHTS_AXIS ? candidate > dp[j - lo] : candidate < dp[j - lo]) {
+				dp[j - lo] = candidate;
+				taken.Set(i, j - lo);
+			}
+		};
+		long long j = hi - 1;
+		for (; j >= lo + shift; --j) {
+			relax(j, dp[j - shift - lo] + gain);
+		}
+		while (j >= lo && j >= shift) {
+			long long got;
+			const long long* values = incoming.Take(j - max(lo, shift) + 1, got);
+			for (long long k = 0; k < got; k++, j--) {
+				relax(j, values[k] + gain);
+			}
+		}
+	}
+
+	ColumnCandidate best = {-1, 0};
+	if (Axis == WEIGHTS_AXIS) {
+		if (lo <= g && g < hi) {
+			best = {g, dp[g - lo]};
+		}
+	} else {
+		for (long long j = hi - 1; j >= lo; --j) {
+			if (dp[j - lo] <= g) {
+				best = {j, j};
+				break;
+			}
+		}
+	}
+	SendValue(coordinator, best);
+
+	long long answerColumn = RecvValue<int64_t>(coordinator);
+	vector<int> chosen;
+	if (lo <= answerColumn) {
+		HaloToken token = {n, answerColumn};
+		if (answerColumn >= hi) {
+			token = RecvValue<HaloToken>(right);
+		}
+		while (token.item >= 1 && token.column >= lo) {
+			long long i = token.item;
+			if (objects[i].weight <= g && taken.Get(i, token.column - lo)) {
+				chosen.push_back(i - 1);
+				token.column -= shiftOf(i);
+			}
+			token.item--;
+		}
+		if (left >= 0) {
+			SendValue(left, token);
+		}
+	}
+	SendVector(coordinator, chosen);
+}
+
+// Registers with the coordinator, joins the chain and runs the kernel.
+inline void RunWorker(const string& coordinatorAddress, const string& listenAddress) {
+	string bound;
+	int listener = Listen(listenAddress, bound);
+	int coordinator = Connect(coordinatorAddress);
+	SendString(coordinator, bound);
+
+	DistributedSetup setup = RecvValue<DistributedSetup>(coordinator);
+	string leftAddress = RecvString(coordinator);
+	vector<Object> objects = RecvVector<Object>(coordinator);
+
+	int left = -1;
+	int right = -1;
+	if (setup.rank > 0) {
+		left = Connect(leftAddress);
+	}
+	if (setup.rank + 1 < setup.count) {
+		right = Accept(listener);
+	}
+	StopListening(listener, bound);
+
+	if (setup.axis == WEIGHTS_AXIS) {
+		DistributedWorkerKernel<WEIGHTS_AXIS>(setup, objects, coordinator, left, right);
+	} else {
+		DistributedWorkerKernel<PROFITS_AXIS>(setup, objects, coordinator, left, right);
+	}
+	for (int fd : {coordinator, left, right}) {
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
+}
+
+// Waits for workers to register on listener, hands out the instance and
+// gathers the answer and the chosen objects.
+inline long long Coordinate(int listener, long long workers, DistributedAxis axis,
+		long long n, long long g, const vector<Object>& objects, vector<int>& out) {
+	vector<int> peers(workers);
+	vector<string> addresses(workers);
+	for (long long k = 0; k < workers; k++) {
+		peers[k] = Accept(listener);
+		addresses[k] = RecvString(peers[k]);
+	}
+
+	long long width = g + 1;
+	if (axis == PROFITS_AXIS) {
+		width = 1;
+		for (long long i = 1; i <= n; i++) {
+			if (objects[i].weight <= g) {
+				width += objects[i].profit;
+			}
+		}
+	}
+	for (long long k = 0; k < workers; k++) {
+		SendValue(peers[k], DistributedSetup{(uint64_t)k, (uint64_t)workers,
+				axis, n, g, width});
+		SendString(peers[k], k > 0 ? addresses[k - 1] : "");
+		SendVector(peers[k], objects);
+	}
+
+	ColumnCandidate best = {-1, 0};
+	for (long long k = 0; k < workers; k++) {
+		ColumnCandidate candidate = RecvValue<ColumnCandidate>(peers[k]);
+		if (candidate.column > best.column) {
+			best = candidate;
+		}
+	}
+	for (long long k = 0; k < workers; k++) {
+		SendValue<int64_t>(peers[k], best.column);
+	}
+	for (long long k = 0; k < workers; k++) {
+		vector<int> chosen = RecvVector<int>(peers[k]);
+		out.insert(out.end(), chosen.begin(), chosen.end());
+		close(peers[k]);
+	}
+	sort(out.begin(), out.end());
+	return best.value;
+}
+
+#endif // DISTRIBUTED_H
@@ -35,76 +35,29 @@
 // This dynamic approach on weight is very sensitive to big profits and
 // maxProfits, for both time and space wise.
 //
+// Out of core:
+// Building the solution needs a decision bit for every (object, profit) pair,
+// which for big instances does not fit in memory. Given a spill file as the
+// second argument, only the current row is kept in memory and the decision
+// bits are streamed to that file, then read back in reverse while building the
+// solution. The row is checkpointed every few objects, so a solve that gets
+// killed resumes from its last checkpoint when started again with the same
+// spill file. See outofcore.h.
+//
+// Usage: dynamicforprofits.exe <test> [spill file]
+//
 // Solution by SPyofgame (CodeForces)[https://codeforces.com/blog/entry/88660#other]
 //
 // *****************************************************************************
 
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <cmath>
-using namespace std;
-
-struct Object {
-    long long weight;
-    long long profit;
-};
-
-int N, G;
-
-vector<Object> ReadData(char* fileName) {
-	ifstream fin(fileName);
-
-  fin >> N >> G;
-	vector<Object> objects(N + 1);
-  for (int i = 1; i <= N; i++) {
-    fin >> objects[i].weight;
-    fin >> objects[i].profit;
-  }
-
-	fin.close();
-	return objects;
-}
-
-long long DynamicForProfits(int n, int g, vector<Object>& objects, vector<int>& out) {
-	long long maxProfitSum = 0;
-	for (long long i = 0; i < objects.size(); i++) {
-		maxProfitSum = max(maxProfitSum, maxProfitSum + objects[i].profit);
-	}
- 	vector<vector<long long>> dp(n + 1, vector<long long>(maxProfitSum + 1, INT64_MAX - g));
-	dp[0][0] = 0;
-
-	for (long long i = 1; i <= n; ++i) {
-		for (long long j = 0; j <= maxProfitSum; ++j) {
-			dp[i][j] = dp[i - 1][j];
-			if (j < objects[i].profit) {
-				continue;
-			}
-			dp[i][j] = min(dp[i][j], dp[i - 1][j - objects[i].profit] + objects[i].weight);
-		}
-	}
-
-	long long ans;
-	for (ans = maxProfitSum; ans >= 0; --ans) {
-		if (dp[n][ans] <= G) {
-			break;
-		}
-	}
-
-	// Build solution
-	long long searchAns = ans;
-	for (long long i = n; i >= 1; --i) {
-		if (dp[i][searchAns] == dp[i - 1][searchAns]) {
-			continue;
-		}
-		out.push_back(i - 1);
-		searchAns -= objects[i].profit;
-	}
-	return ans;
-}
+#include "knapsack.h"
+#include "outofcore.h"
 
 int main(int argc, char** argv) {
 	vector<Object> objects = ReadData(argv[1]);
 	vector<int> items;
-	return DynamicForProfits(N, G, objects, items);
+	if (argc > 2) {
+		return OutOfCoreDynamicForProfits<true>(N, G, objects, argv[2], items);
+	}
+	return DynamicForProfits<true>(N, G, objects, items);
 }
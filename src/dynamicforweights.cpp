@@ -31,58 +31,10 @@
 //
 // *****************************************************************************
 
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <cmath>
-using namespace std;
-
-struct Object {
-    long long weight;
-    long long profit;
-};
-
-int N, G;
-
-vector<Object> ReadData(char* fileName) {
-	ifstream fin(fileName);
-
-  fin >> N >> G;
-	vector<Object> objects(N + 1);
-  for (int i = 1; i <= N; i++) {
-    fin >> objects[i].weight;
-    fin >> objects[i].profit;
-  }
-
-	fin.close();
-	return objects;
-}
-
-long long DynamicForWeights(int n, int g, vector<Object>& objects,
-		vector<int>& out) {
- 	vector<vector<long long>> dp(n + 1, vector<long long>(g + 1));
-	for (long long i = 1; i <= n; ++i) {
-		for (long long j = 1; j <= g; ++j) {
-			dp[i][j] = max(dp[i][j - 1], dp[i - 1][j]);
-			if (j >= objects[i].weight) {
-				dp[i][j] = max(dp[i][j],
-						dp[i - 1][j - objects[i].weight] + objects[i].profit);
-			}
-		}
-	}
-
-	// Build solution
-	for (long long i = n; i >= 1; --i) {
-		if (dp[i][g] == dp[i - 1][g]) {
-			continue;
-		}
-		out.push_back(i - 1);
-	}
-	return dp[n][g];
-}
+#include "knapsack.h"
 
 int main(int argc, char** argv) {
 	vector<Object> objects = ReadData(argv[1]);
 	vector<int> items;
-	return DynamicForWeights(N, G, objects, items);
+	return DynamicForWeights<true>(N, G, objects, items);
 }
@@ -25,6 +25,9 @@
 // The computed solution is correct within of factor of (1 - eps) of the best
 // solution.
 //
+// Objects heavier than G can never be picked, so they are left out of
+// biggestProfit, and n counts only the real objects, not the empty objects[0].
+//
 // Complexity:
 // Time - O(n + n * maxProfit / K), where K = eps * biggestProfit / n, so the time
 // complexity becomes O(n + maxProfit / (eps * biggestProfit))
@@ -37,88 +40,11 @@
 //
 // *****************************************************************************
 
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <cmath>
 #include <stdlib.h>
-using namespace std;
-
-struct Object {
-    long long weight;
-    long long profit;
-};
-
-int N, G;
-
-vector<Object> ReadData(char* fileName) {
-	ifstream fin(fileName);
-
-  fin >> N >> G;
-	vector<Object> objects(N + 1);
-  for (int i = 1; i <= N; i++) {
-    fin >> objects[i].weight;
-    fin >> objects[i].profit;
-  }
-
-	fin.close();
-	return objects;
-}
-
-long long DynamicForProfits(int n, int g, vector<Object>& objects, vector<int>& out) {
-	long long maxProfitSum = 0;
-	for (long long i = 0; i < objects.size(); i++) {
-		maxProfitSum = max(maxProfitSum, maxProfitSum + objects[i].profit);
-	}
- 	vector<vector<long long>> dp(n + 1, vector<long long>(maxProfitSum + 1, INT64_MAX - g));
-	dp[0][0] = 0;
-
-	for (long long i = 1; i <= n; ++i) {
-		for (long long j = 0; j <= maxProfitSum; ++j) {
-			dp[i][j] = dp[i - 1][j];
-			if (j < objects[i].profit) {
-				continue;
-			}
-			dp[i][j] = min(dp[i][j], dp[i - 1][j - objects[i].profit] + objects[i].weight);
-		}
-	}
-
-	long long ans;
-	for (ans = maxProfitSum; ans >= 0; --ans) {
-		if (dp[n][ans] <= G) {
-			break;
-		}
-	}
-
-	// Build solution
-	long long searchAns = ans;
-	for (long long i = n; i >= 1; --i) {
-		if (dp[i][searchAns] == dp[i - 1][searchAns]) {
-			continue;
-		}
-		out.push_back(i - 1);
-		searchAns -= objects[i].profit;
-	}
-	return ans;
-}
-
-long long FPTAS(int n, int g, vector<Object>& objects, double eps, vector<int>& out) {
-	long long maxProfit = 0;
-	for (int i = 1; i < objects.size(); i++) {
-		maxProfit = max(maxProfit, objects[i].profit);
-	}
-	double scalingFactor = eps * maxProfit / objects.size();
-	vector<Object> scaledObjects(objects.size());
-	for (int i = 1; i < objects.size(); i++) {
-		scaledObjects[i] = {
-			objects[i].weight,
-			(long long)(objects[i].profit / scalingFactor)};
-	}
-	return (double)DynamicForProfits(n, g, scaledObjects, out) * scalingFactor;
-}
+#include "knapsack.h"
 
 int main(int argc, char** argv) {
 	vector<Object> objects = ReadData(argv[1]);
 	vector<int> items;
-	return FPTAS(N, G, objects, atof(argv[2]), items);
+	return FPTAS<true>(N, G, objects, atof(argv[2]), items);
 }
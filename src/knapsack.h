@@ -0,0 +1,710 @@
+// *****************************************************************************
+// *                              Knapsack Engine                              *
+// *****************************************************************************
+//
+// Everything the solvers share. Every executable is a main over this file.
+//
+// Contents:
+// Object, N, G, ReadData - the instance, with objects 1-indexed
+// SolverStats, Stats - counters updated by the cache
+// HashCombine - FNV-1a, used to identify instances
+// BruteForce - exhaustive search, see bruteforce.cpp
+// DynamicForWeights, DynamicForProfits - the dynamics, see their .cpp files
+// MinKnap - expanding core solver, see minknap.cpp
+// FPTAS - approximation over DynamicForProfits, see fptas.cpp
+// Algorithm, Solve - runs any of the above by name
+//
+// The dynamic kernels are templates on:
+// Cell - the type stored in the dp row (profits or weights)
+// Index - the type used for the dp columns and the item counter
+// BuildSolution - whether the chosen items are recovered or only the answer
+//
+// Every solver takes BuildSolution. When it is false only the answer is
+// computed. When it is true the dynamics also set a bit in a DecisionBits
+// table on every improvement, so reconstruction costs n * width bits.
+//
+// DynamicForWeights and DynamicForProfits look at the instance bounds and
+// instantiate the narrowest kernel that can not overflow.
+//
+// *****************************************************************************
+
+#ifndef KNAPSACK_H
+#define KNAPSACK_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+using namespace std;
+
+struct Object {
+	long long weight;
+	long long profit;
+};
+
+inline long long N, G;
+
+// Counters shared by everything that solves through the engine.
+struct SolverStats {
+	long long cacheHits = 0;
+	long long diskHits = 0;
+	long long cacheMisses = 0;
+};
+
+inline SolverStats Stats;
+
+const uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+// FNV-1a over the 8 bytes of value.
+inline uint64_t HashCombine(uint64_t hash, uint64_t value) {
+	for (int b = 0; b < 8; b++) {
+		hash ^= value >> (8 * b) & 0xff;
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+// Objects are 1-indexed, objects[0] is an empty object.
+inline vector<Object> ReadData(char* fileName) {
+	ifstream fin(fileName);
+
+	fin >> N >> G;
+	vector<Object> objects(N + 1);
+	for (long long i = 1; i <= N; i++) {
+		fin >> objects[i].weight;
+		fin >> objects[i].profit;
+	}
+
+	fin.close();
+	return objects;
+}
+
+// One bit per (item, column), set when the item improved that column. Rows are
+// packed into 64 bit words.
+struct DecisionBits {
+	size_t words = 0;
+	vector<uint64_t> bits;
+
+	DecisionBits() = default;
+	DecisionBits(size_t rows, size_t width)
+			: words((width + 63) / 64), bits(rows * words, 0) {}
+
+	void Set(size_t row, size_t column) {
+		bits[row * words + column / 64] |= 1ULL << (column % 64);
+	}
+
+	bool Get(size_t row, size_t column) const {
+		return bits[row * words + column / 64] >> (column % 64) & 1;
+	}
+};
+
+// Walks the subsets of the last lowBits items in Gray code order, starting from
+// the subset `start`. Consecutive subsets differ by exactly one item, so the
+// running weight and profit are kept with one add or subtract per step.
+inline void GrayCodeRange(const vector<Object>& items, long long g,
+		int lowBits, uint64_t start, long long& bestProfit, uint64_t& bestMask) {
+	uint64_t mask = start;
+	long long weight = 0;
+	long long profit = 0;
+	for (size_t b = 0; b < items.size(); b++) {
+		if (mask >> b & 1) {
+			weight += items[b].weight;
+			profit += items[b].profit;
+		}
+	}
+	if (weight <= g && profit > bestProfit) {
+		bestProfit = profit;
+		bestMask = mask;
+	}
+
+	uint64_t steps = 1ULL << lowBits;
+	for (uint64_t k = 1; k < steps; k++) {
+		int b = __builtin_ctzll(k);
+		mask ^= 1ULL << b;
+		if (mask >> b & 1) {
+			weight += items[b].weight;
+			profit += items[b].profit;
+		} else {
+			weight -= items[b].weight;
+			profit -= items[b].profit;
+		}
+		if (weight <= g && profit > bestProfit) {
+			bestProfit = profit;
+			bestMask = mask;
+		}
+	}
+}
+
+// Depth first search that cuts every branch going over g, so it only visits
+// the subsets that fit.
+inline void PrunedBruteForce(const vector<Object>& items, long long g,
+		size_t index, long long weight, long long profit, vector<int>& current,
+		long long& bestProfit, vector<int>& best) {
+	if (index == items.size()) {
+		if (profit > bestProfit) {
+			bestProfit = profit;
+			best = current;
+		}
+		return;
+	}
+	if (weight + items[index].weight <= g) {
+		current.push_back(index);
+		PrunedBruteForce(items, g, index + 1, weight + items[index].weight,
+				profit + items[index].profit, current, bestProfit, best);
+		current.pop_back();
+	}
+	PrunedBruteForce(items, g, index + 1, weight, profit, current, bestProfit, best);
+}
+
+// Whether the pruned search visits far fewer subsets than the 2^m of the Gray
+// code walk. For a small g the subsets that fit are counted exactly, with a
+// dynamic on weights. Otherwise, if the k lightest items are the most that fit
+// together, at most C(m, 0) + ... + C(m, k) subsets fit. The search pays a few
+// calls for each of them, against one step per subset for the Gray code walk.
+inline bool PreferPruned(const vector<Object>& items, long long g) {
+	size_t m = items.size();
+	if (m >= 64) {
+		return true;
+	}
+
+	double fitting = 0;
+	if ((double)m * g <= (1 << 24)) {
+		vector<double> count(g + 1, 0);
+		count[0] = 1;
+		for (const Object& item : items) {
+			for (long long j = g; j >= item.weight; --j) {
+				count[j] += count[j - item.weight];
+			}
+		}
+		for (double c : count) {
+			fitting += c;
+		}
+	} else {
+		vector<long long> weights;
+		for (const Object& item : items) {
+			weights.push_back(item.weight);
+		}
+		sort(weights.begin(), weights.end());
+		size_t k = 0;
+		long long weight = 0;
+		while (k < m && weight + weights[k] <= g) {
+			weight += weights[k];
+			k++;
+		}
+		double binomial = 1;
+		for (size_t i = 0; i <= k; i++) {
+			fitting += binomial;
+			binomial = binomial * (m - i) / (i + 1);
+		}
+	}
+	return fitting * 16 < ldexp(1.0, m);
+}
+
+// Exhaustive search. Objects heavier than g are dropped first. When g is tight
+// or there are 64 objects or more, the pruned search is used. Otherwise the
+// Gray code walk is used, with the mask space split on its top bits into one
+// chunk per thread.
+template <bool BuildSolution>
+long long BruteForce(long long n, long long g, const vector<Object>& objects,
+		vector<int>& out, unsigned threads = 1) {
+	vector<Object> items;
+	vector<int> index;
+	for (long long i = 1; i <= n; i++) {
+		if (objects[i].weight <= g) {
+			items.push_back(objects[i]);
+			index.push_back(i - 1);
+		}
+	}
+	int m = items.size();
+
+	if (PreferPruned(items, g)) {
+		long long bestProfit = 0;
+		vector<int> best;
+		vector<int> current;
+		PrunedBruteForce(items, g, 0, 0, 0, current, bestProfit, best);
+		if constexpr (BuildSolution) {
+			for (int b : best) {
+				out.push_back(index[b]);
+			}
+		}
+		return bestProfit;
+	}
+
+	int splitBits = 0;
+	while (splitBits < m && (1U << (splitBits + 1)) <= max(threads, 1U)) {
+		splitBits++;
+	}
+	int lowBits = m - splitBits;
+	uint64_t chunks = 1ULL << splitBits;
+
+	vector<long long> bestProfit(chunks, 0);
+	vector<uint64_t> bestMask(chunks, 0);
+	vector<thread> workers;
+	for (uint64_t c = 0; c < chunks; c++) {
+		workers.emplace_back(GrayCodeRange, cref(items), g, lowBits,
+				c << lowBits, ref(bestProfit[c]), ref(bestMask[c]));
+	}
+	for (thread& worker : workers) {
+		worker.join();
+	}
+
+	uint64_t best = 0;
+	for (uint64_t c = 1; c < chunks; c++) {
+		if (bestProfit[c] > bestProfit[best]) {
+			best = c;
+		}
+	}
+
+	if constexpr (BuildSolution) {
+		for (int b = 0; b < m; b++) {
+			if (bestMask[best] >> b & 1) {
+				out.push_back(index[b]);
+			}
+		}
+	}
+	return bestProfit[best];
+}
+
+// dp[j] = the maximum profit for a weight of at most j
+template <typename Cell, typename Index, bool BuildSolution>
+long long DynamicForWeightsKernel(long long n, long long g,
+		const vector<Object>& objects, vector<int>& out) {
+	Index capacity = (Index)g;
+	vector<Cell> dp(capacity + 1, 0);
+	DecisionBits taken;
+	if constexpr (BuildSolution) {
+		taken = DecisionBits(n + 1, capacity + 1);
+	}
+
+	for (Index i = 1; i <= (Index)n; ++i) {
+		if (objects[i].weight > g) {
+			continue;
+		}
+		Index weight = (Index)objects[i].weight;
+		Cell profit = (Cell)objects[i].profit;
+		for (Index j = capacity; j >= weight; --j) {
+			Cell candidate = dp[j - weight] + profit;
+			if constexpr (BuildSolution) {
+				if (candidate > dp[j]) {
+					dp[j] = candidate;
+					taken.Set(i, j);
+				}
+			} else {
+				dp[j] = max(dp[j], candidate);
+			}
+		}
+	}
+
+	if constexpr (BuildSolution) {
+		Index j = capacity;
+		for (Index i = (Index)n; i >= 1; --i) {
+			if (taken.Get(i, j)) {
+				out.push_back(i - 1);
+				j -= (Index)objects[i].weight;
+			}
+		}
+	}
+	return dp[capacity];
+}
+
+// dp[j] = the minimum weight for a profit of exactly j
+//
+// Every state heavier than g is as good as unreachable, so g + 1 is used as
+// infinity and a cell never needs to hold more than 2 * g + 1.
+template <typename Cell, typename Index, bool BuildSolution>
+long long DynamicForProfitsKernel(long long n, long long g,
+		const vector<Object>& objects, long long maxProfitSum,
+		vector<int>& out) {
+	const Cell inf = (Cell)g + 1;
+	vector<Cell> dp(maxProfitSum + 1, inf);
+	dp[0] = 0;
+	DecisionBits taken;
+	if constexpr (BuildSolution) {
+		taken = DecisionBits(n + 1, maxProfitSum + 1);
+	}
+
+	Index profitSum = 0;
+	for (Index i = 1; i <= (Index)n; ++i) {
+		if (objects[i].weight > g) {
+			continue;
+		}
+		Index profit = (Index)objects[i].profit;
+		Cell weight = (Cell)objects[i].weight;
+		profitSum += profit;
+		for (Index j = profitSum; j >= profit; --j) {
+			Cell candidate = dp[j - profit] + weight;
+			if constexpr (BuildSolution) {
+				if (candidate < dp[j]) {
+					dp[j] = candidate;
+					taken.Set(i, j);
+				}
+			} else {
+				dp[j] = min(dp[j], candidate);
+			}
+		}
+	}
+
+	Index ans = profitSum;
+	while (ans > 0 && dp[ans] > (Cell)g) {
+		--ans;
+	}
+
+	if constexpr (BuildSolution) {
+		Index j = ans;
+		for (Index i = (Index)n; i >= 1; --i) {
+			if (taken.Get(i, j)) {
+				out.push_back(i - 1);
+				j -= (Index)objects[i].profit;
+			}
+		}
+	}
+	return ans;
+}
+
+template <bool BuildSolution>
+long long DynamicForWeights(long long n, long long g,
+		const vector<Object>& objects, vector<int>& out) {
+	long long profitSum = 0;
+	for (long long i = 1; i <= n; i++) {
+		if (objects[i].weight <= g) {
+			profitSum += objects[i].profit;
+		}
+	}
+
+	bool narrowCell = profitSum <= INT32_MAX;
+	bool narrowIndex = g < INT32_MAX && n < INT32_MAX;
+	if (narrowCell && narrowIndex) {
+		return DynamicForWeightsKernel<int32_t, int32_t, BuildSolution>(n, g, objects, out);
+	}
+	if (narrowIndex) {
+		return DynamicForWeightsKernel<int64_t, int32_t, BuildSolution>(n, g, objects, out);
+	}
+	if (narrowCell) {
+		return DynamicForWeightsKernel<int32_t, int64_t, BuildSolution>(n, g, objects, out);
+	}
+	return DynamicForWeightsKernel<int64_t, int64_t, BuildSolution>(n, g, objects, out);
+}
+
+template <bool BuildSolution>
+long long DynamicForProfits(long long n, long long g,
+		const vector<Object>& objects, vector<int>& out) {
+	long long maxProfitSum = 0;
+	for (long long i = 1; i <= n; i++) {
+		if (objects[i].weight <= g) {
+			maxProfitSum += objects[i].profit;
+		}
+	}
+
+	bool narrowCell = 2 * g + 1 <= INT32_MAX;
+	bool narrowIndex = maxProfitSum < INT32_MAX && n < INT32_MAX;
+	if (narrowCell && narrowIndex) {
+		return DynamicForProfitsKernel<int32_t, int32_t, BuildSolution>(n, g, objects, maxProfitSum, out);
+	}
+	if (narrowIndex) {
+		return DynamicForProfitsKernel<int64_t, int32_t, BuildSolution>(n, g, objects, maxProfitSum, out);
+	}
+	if (narrowCell) {
+		return DynamicForProfitsKernel<int32_t, int64_t, BuildSolution>(n, g, objects, maxProfitSum, out);
+	}
+	return DynamicForProfitsKernel<int64_t, int64_t, BuildSolution>(n, g, objects, maxProfitSum, out);
+}
+
+// Compares profit / weight of two objects without rounding.
+inline bool MoreEfficient(const Object& a, const Object& b) {
+	return (__int128)a.profit * b.weight > (__int128)b.profit * a.weight;
+}
+
+struct CoreState {
+	long long weight;
+	long long profit;
+	long long node;
+};
+
+// An item flipped relative to the break solution, chained to the flips made
+// before it. Only used when BuildSolution is true.
+struct CoreToggle {
+	long long item;
+	long long parent;
+};
+
+// Expanding core solver, see minknap.cpp.
+template <bool BuildSolution>
+long long MinKnap(long long n, long long g, const vector<Object>& objects,
+		vector<int>& out) {
+	vector<char> chosen;
+	if constexpr (BuildSolution) {
+		chosen.assign(n + 1, 0);
+	}
+
+	// Objects that can never fit or never help are dropped, weightless ones
+	// are always taken.
+	long long fixedProfit = 0;
+	vector<long long> order;
+	for (long long i = 1; i <= n; i++) {
+		if (objects[i].weight > g || objects[i].profit <= 0) {
+			continue;
+		}
+		if (objects[i].weight == 0) {
+			fixedProfit += objects[i].profit;
+			if constexpr (BuildSolution) {
+				chosen[i] = 1;
+			}
+			continue;
+		}
+		order.push_back(i);
+	}
+	long long m = order.size();
+	auto better = [&](long long a, long long b) {
+		return MoreEfficient(objects[a], objects[b]);
+	};
+	auto sortRange = [&](long long from, long long to) {
+		sort(order.begin() + from, order.begin() + to, better);
+	};
+
+	// Partial sort. Quickselect on efficiency around the break item, but
+	// every part that is thrown away is remembered as an unsorted interval.
+	// Everything in a left interval is at least as efficient as anything to
+	// its right, and the other way around for the right intervals.
+	vector<pair<long long, long long>> leftIntervals;
+	vector<pair<long long, long long>> rightIntervals;
+	long long lo = 0;
+	long long hi = m;
+	long long breakWeight = 0;
+	while (hi - lo > 16) {
+		long long pivot = order[lo + (hi - lo) / 2];
+		long long i = partition(order.begin() + lo, order.begin() + hi,
+				[&](long long x) { return better(x, pivot); }) - order.begin();
+		long long j = partition(order.begin() + i, order.begin() + hi,
+				[&](long long x) { return !better(pivot, x); }) - order.begin();
+
+		long long betterWeight = 0;
+		long long equalWeight = 0;
+		for (long long k = lo; k < i; k++) {
+			betterWeight += objects[order[k]].weight;
+		}
+		for (long long k = i; k < j; k++) {
+			equalWeight += objects[order[k]].weight;
+		}
+
+		if (breakWeight + betterWeight > g) {
+			rightIntervals.push_back({i, hi});
+			hi = i;
+		} else if (breakWeight + betterWeight + equalWeight > g) {
+			leftIntervals.push_back({lo, i});
+			rightIntervals.push_back({j, hi});
+			breakWeight += betterWeight;
+			lo = i;
+			hi = j;
+			break;
+		} else {
+			leftIntervals.push_back({lo, j});
+			breakWeight += betterWeight + equalWeight;
+			lo = j;
+		}
+	}
+	sortRange(lo, hi);
+
+	long long b = lo;
+	while (b < hi && breakWeight + objects[order[b]].weight <= g) {
+		breakWeight += objects[order[b]].weight;
+		b++;
+	}
+	long long breakProfit = 0;
+	for (long long k = 0; k < b; k++) {
+		breakProfit += objects[order[k]].profit;
+	}
+
+	// [sortedLeft, sortedRight) is sorted, the intervals outside of it are
+	// sorted only once the core reaches them.
+	long long sortedLeft = lo;
+	long long sortedRight = hi;
+	auto ensureSorted = [&](long long s, long long t) {
+		while (t < m && t >= sortedRight) {
+			auto [from, to] = rightIntervals.back();
+			rightIntervals.pop_back();
+			sortRange(from, to);
+			sortedRight = to;
+		}
+		while (s > 0 && s - 1 < sortedLeft) {
+			auto [from, to] = leftIntervals.back();
+			leftIntervals.pop_back();
+			sortRange(from, to);
+			sortedLeft = from;
+		}
+	};
+
+	vector<CoreState> states = {{breakWeight, breakProfit, -1}};
+	vector<CoreToggle> toggles;
+	long long best = breakProfit;
+	long long bestNode = -1;
+
+	// Merges the states with a copy of them where the item is flipped. Both
+	// lists are sorted by weight, so the result is too, and every state that
+	// is not strictly more profitable than a lighter one is dropped.
+	auto expand = [&](long long item, long long sign) {
+		long long dw = sign * objects[item].weight;
+		long long dp = sign * objects[item].profit;
+		vector<CoreState> next;
+		next.reserve(2 * states.size());
+		size_t a = 0;
+		size_t c = 0;
+		while (a < states.size() || c < states.size()) {
+			bool flipped = a == states.size() ||
+					(c < states.size() && (states[c].weight + dw < states[a].weight ||
+					(states[c].weight + dw == states[a].weight &&
+					states[c].profit + dp > states[a].profit)));
+			CoreState state = flipped ?
+					CoreState{states[c].weight + dw, states[c].profit + dp, states[c].node} :
+					states[a];
+			flipped ? c++ : a++;
+
+			if (!next.empty() && state.profit <= next.back().profit) {
+				continue;
+			}
+			if (!next.empty() && state.weight == next.back().weight) {
+				next.pop_back();
+			}
+			if constexpr (BuildSolution) {
+				if (flipped) {
+					toggles.push_back({item, state.node});
+					state.node = toggles.size() - 1;
+				}
+			}
+			next.push_back(state);
+		}
+		states.swap(next);
+	};
+
+	// Keeps only the states whose upper bound can still beat the best
+	// solution. Under the capacity the remaining room is filled at the
+	// efficiency of the next item to add, over it the excess is removed at
+	// the efficiency of the next item to remove.
+	auto reduce = [&](long long s, long long t) {
+		ensureSorted(s, t);
+		size_t kept = 0;
+		for (const CoreState& state : states) {
+			if (state.weight <= g && state.profit > best) {
+				best = state.profit;
+				bestNode = state.node;
+			}
+		}
+		for (const CoreState& state : states) {
+			bool promising;
+			if (state.weight <= g) {
+				promising = t < m &&
+						(__int128)(state.profit - best - 1) * objects[order[t]].weight +
+						(__int128)(g - state.weight) * objects[order[t]].profit >= 0;
+			} else {
+				promising = s > 0 &&
+						(__int128)(state.profit - best - 1) * objects[order[s - 1]].weight -
+						(__int128)(state.weight - g) * objects[order[s - 1]].profit >= 0;
+			}
+			if (promising) {
+				states[kept++] = state;
+			}
+		}
+		states.resize(kept);
+	};
+
+	long long s = b;
+	long long t = b;
+	reduce(s, t);
+	while (!states.empty() && (s > 0 || t < m)) {
+		if (t < m) {
+			expand(order[t], 1);
+			t++;
+			reduce(s, t);
+		}
+		if (s > 0 && !states.empty()) {
+			expand(order[s - 1], -1);
+			s--;
+			reduce(s, t);
+		}
+	}
+
+	if constexpr (BuildSolution) {
+		for (long long k = 0; k < b; k++) {
+			chosen[order[k]] = 1;
+		}
+		for (long long node = bestNode; node != -1; node = toggles[node].parent) {
+			chosen[toggles[node].item] ^= 1;
+		}
+		for (long long i = 1; i <= n; i++) {
+			if (chosen[i]) {
+				out.push_back(i - 1);
+			}
+		}
+	}
+	return best + fixedProfit;
+}
+
+// Scales the profits by K = eps * biggestProfit / n and runs the dynamic on
+// profits over the scaled objects. See fptas.cpp.
+template <bool BuildSolution>
+long long FPTAS(long long n, long long g, const vector<Object>& objects,
+		double eps, vector<int>& out) {
+	long long maxProfit = 0;
+	for (long long i = 1; i <= n; i++) {
+		if (objects[i].weight <= g) {
+			maxProfit = max(maxProfit, objects[i].profit);
+		}
+	}
+	if (maxProfit == 0) {
+		return 0;
+	}
+
+	double scalingFactor = eps * maxProfit / n;
+	vector<Object> scaledObjects(objects.size(), {0, 0});
+	for (long long i = 1; i <= n; i++) {
+		scaledObjects[i] = {
+			objects[i].weight,
+			(long long)(objects[i].profit / scalingFactor)};
+	}
+	return (double)DynamicForProfits<BuildSolution>(n, g, scaledObjects, out) * scalingFactor;
+}
+
+enum class Algorithm {
+	BruteForce,
+	DynamicForWeights,
+	DynamicForProfits,
+	FPTAS,
+	MinKnap,
+};
+
+// Algorithms are named after their executables, e.g. "dynamicforweights".
+inline bool ParseAlgorithm(const char* name, Algorithm& algorithm) {
+	const char* names[] = {"bruteforce", "dynamicforweights",
+			"dynamicforprofits", "fptas", "minknap"};
+	for (int a = 0; a < 5; a++) {
+		if (strcmp(name, names[a]) == 0) {
+			algorithm = (Algorithm)a;
+			return true;
+		}
+	}
+	return false;
+}
+
+// eps is only used by FPTAS.
+template <bool BuildSolution>
+long long Solve(Algorithm algorithm, long long n, long long g,
+		const vector<Object>& objects, double eps, vector<int>& out) {
+	switch (algorithm) {
+	case Algorithm::BruteForce:
+		return BruteForce<BuildSolution>(n, g, objects, out, thread::hardware_concurrency());
+	case Algorithm::DynamicForWeights:
+		return DynamicForWeights<BuildSolution>(n, g, objects, out);
+	case Algorithm::DynamicForProfits:
+		return DynamicForProfits<BuildSolution>(n, g, objects, out);
+	case Algorithm::FPTAS:
+		return FPTAS<BuildSolution>(n, g, objects, eps, out);
+	case Algorithm::MinKnap:
+		return MinKnap<BuildSolution>(n, g, objects, out);
+	}
+	return 0;
+}
+
+#endif // KNAPSACK_H
@@ -0,0 +1,55 @@
+// *****************************************************************************
+// *                     Expanding core (Pisinger's minknap)                   *
+// *****************************************************************************
+//
+// This approach works best for a big number of objects with big weights and
+// big profits, where both dynamics are out of reach.
+//
+// If we sort the objects by efficiency (profit / weight) and greedily take
+// them until the next one does not fit, we get the break solution and the
+// break item b. The optimal solution almost always differs from it only for
+// the objects around b, the core. Far better objects are taken, far worse
+// ones are not.
+//
+// Finding b does not need a full sort. A quickselect on efficiency, that
+// only follows the side where the capacity runs out, finds it in linear time.
+// Every side it throws away is remembered as an unsorted interval and only
+// sorted once the core grows into it.
+//
+// The core starts empty, as [b, b), and alternately grows by one object to
+// the right (which may now be added) and one object to the left (which may
+// now be removed). Instead of a full row, the dynamic keeps a sparse list of
+// states (weight, profit), sorted by weight, where every state is strictly
+// more profitable than all the lighter ones. States over the capacity are kept
+// since removing an object can bring them back under it.
+//
+// After every step each state is bounded:
+// weight <= G : profit + (G - weight) * e(t)
+// weight > G  : profit - (weight - G) * e(s - 1)
+// where t is the next object to add and s - 1 the next one to remove. A state
+// whose bound can not beat the best solution found so far is dropped. The
+// solve ends when no states are left.
+//
+// When the solution is built, every state keeps a link to the chain of
+// objects it flipped relative to the break solution.
+//
+// Complexity:
+// Time - O(n) for the partial sort, plus the core dynamic, which stays small
+// for uncorrelated and weakly correlated data. O(n * G) in the worst case.
+// Space - O(n + number of states)
+//
+// Cons:
+// Strongly correlated data (profit = weight + constant) keeps a lot of states
+// alive and makes the core grow very wide.
+//
+// Algorithm from D. Pisinger, A Minimal Algorithm for the 0-1 Knapsack Problem
+//
+// *****************************************************************************
+
+#include "knapsack.h"
+
+int main(int argc, char** argv) {
+	vector<Object> objects = ReadData(argv[1]);
+	vector<int> items;
+	return MinKnap<true>(N, G, objects, items);
+}
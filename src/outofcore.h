@@ -0,0 +1,352 @@
+// *****************************************************************************
+// *                      Out of core Dynamic for profits                      *
+// *****************************************************************************
+//
+// Same dynamic as DynamicForProfitsKernel, but nothing that grows with n is
+// kept in memory. Only the current row lives in RAM.
+//
+// Spill file:
+// After every object, the decision bits of the columns it could have touched,
+// [profit, profitSum], are run length encoded and appended to the spill file
+// through a big buffer, so the disk only sees large sequential writes. Every
+// object gets one record, even the ones that did not fit:
+// [first word][last word][tokens...][record length in words]
+// where every token is (zero words << 32 | literal words) followed by the
+// literal words. The trailing length lets the backtracking walk the file from
+// its end towards its start.
+//
+// Checkpoint file (spill file + ".ckpt"):
+// Every checkpointEvery objects the spill buffer is flushed and the row is
+// written next to a CheckpointHeader, through a temporary file that is then
+// renamed over the old checkpoint. A solve that finds a checkpoint for the
+// same instance cuts the spill file back to the size recorded in it and goes
+// on from the next object instead of from zero.
+//
+// Both files are removed once the solution is built.
+//
+// *****************************************************************************
+
+#ifndef OUTOFCORE_H
+#define OUTOFCORE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include "knapsack.h"
+
+const uint64_t CHECKPOINT_MAGIC = 0x4b4e41505343504bULL;
+const size_t SPILL_BUFFER_WORDS = 1 << 21;
+const size_t SPILL_READ_WORDS = 1 << 21;
+
+struct CheckpointHeader {
+	uint64_t magic;
+	uint64_t instanceHash;
+	uint64_t cellSize;
+	uint64_t buildSolution;
+	int64_t nextItem;
+	int64_t profitSum;
+	int64_t spillWords;
+};
+
+inline void SpillFail(const string& path) {
+	perror(path.c_str());
+	exit(EXIT_FAILURE);
+}
+
+inline void SpillFail(const string& path, const error_code& error) {
+	fprintf(stderr, "%s: %s\n", path.c_str(), error.message().c_str());
+	exit(EXIT_FAILURE);
+}
+
+// Hashes the instance in its original order, a checkpoint only matches the
+// exact same input.
+inline uint64_t InstanceHash(long long n, long long g,
+		const vector<Object>& objects) {
+	uint64_t hash = HashCombine(HashCombine(FNV_OFFSET, n), g);
+	for (long long i = 1; i <= n; i++) {
+		hash = HashCombine(hash, objects[i].weight);
+		hash = HashCombine(hash, objects[i].profit);
+	}
+	return hash;
+}
+
+// Appends words to the spill file through a SPILL_BUFFER_WORDS buffer.
+struct SpillWriter {
+	ofstream file;
+	vector<uint64_t> buffer;
+	int64_t words = 0;
+
+	SpillWriter(const string& path, int64_t keepWords) {
+		if (keepWords == 0 && !ofstream(path, ios::binary | ios::trunc)) {
+			SpillFail(path);
+		}
+		error_code error;
+		filesystem::resize_file(path, keepWords * sizeof(uint64_t), error);
+		if (error) {
+			SpillFail(path, error);
+		}
+		file.open(path, ios::binary | ios::app);
+		if (!file) {
+			SpillFail(path);
+		}
+		buffer.reserve(SPILL_BUFFER_WORDS);
+		words = keepWords;
+	}
+
+	void Write(uint64_t word) {
+		buffer.push_back(word);
+		words++;
+		if (buffer.size() == SPILL_BUFFER_WORDS) {
+			Flush();
+		}
+	}
+
+	void Flush() {
+		file.write((const char*)buffer.data(), buffer.size() * sizeof(uint64_t));
+		file.flush();
+		buffer.clear();
+	}
+};
+
+// Writes the words [first, last] of row as one record and clears them.
+inline void SpillRecord(SpillWriter& writer, vector<uint64_t>& row,
+		size_t first, size_t last) {
+	int64_t start = writer.words;
+	writer.Write(first);
+	writer.Write(last);
+	size_t w = first;
+	while (w <= last && first <= last) {
+		size_t zeros = 0;
+		while (w + zeros <= last && row[w + zeros] == 0) {
+			zeros++;
+		}
+		size_t literals = 0;
+		while (w + zeros + literals <= last && row[w + zeros + literals] != 0) {
+			literals++;
+		}
+		if (literals == 0) {
+			break;
+		}
+		writer.Write((uint64_t)zeros << 32 | literals);
+		for (size_t k = w + zeros; k < w + zeros + literals; k++) {
+			writer.Write(row[k]);
+			row[k] = 0;
+		}
+		w += zeros + literals;
+	}
+	writer.Write(writer.words - start + 1);
+}
+
+// Walks the records of the spill file from the last one to the first,
+// SPILL_READ_WORDS at a time.
+struct SpillReader {
+	ifstream file;
+	vector<uint64_t> window;
+	int64_t windowStart = 0;
+	int64_t end;
+
+	SpillReader(const string& path, int64_t words) : file(path, ios::binary), end(words) {
+		if (!file) {
+			SpillFail(path);
+		}
+		Load(end, 1);
+	}
+
+	// Makes sure the words [to - count, to) are in the window.
+	void Load(int64_t to, int64_t count) {
+		if (to - count >= windowStart && to <= windowStart + (int64_t)window.size()) {
+			return;
+		}
+		int64_t size = min<int64_t>(to, max<int64_t>(count, SPILL_READ_WORDS));
+		windowStart = to - size;
+		window.resize(size);
+		file.seekg(windowStart * sizeof(uint64_t));
+		file.read((char*)window.data(), size * sizeof(uint64_t));
+	}
+
+	uint64_t At(int64_t position) {
+		return window[position - windowStart];
+	}
+
+	// Reads the bit of column in the record ending at end and moves end to
+	// the start of that record.
+	bool PopBit(size_t column) {
+		Load(end, 1);
+		int64_t length = At(end - 1);
+		int64_t start = end - length;
+		Load(end, length);
+		end = start;
+
+		size_t first = At(start);
+		size_t last = At(start + 1);
+		size_t word = column / 64;
+		if (first > last || word < first || word > last) {
+			return false;
+		}
+		size_t w = first;
+		for (int64_t p = start + 2; p < start + length - 1; ) {
+			uint64_t token = At(p++);
+			size_t zeros = token >> 32;
+			size_t literals = token & 0xffffffffULL;
+			if (word < w + zeros) {
+				return false;
+			}
+			if (word < w + zeros + literals) {
+				return At(p + word - w - zeros) >> (column % 64) & 1;
+			}
+			w += zeros + literals;
+			p += literals;
+		}
+		return false;
+	}
+};
+
+template <typename Cell>
+void WriteCheckpoint(const string& path, const CheckpointHeader& header,
+		const vector<Cell>& dp) {
+	string temporary = path + ".tmp";
+	ofstream file(temporary, ios::binary | ios::trunc);
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)dp.data(), (header.profitSum + 1) * sizeof(Cell));
+	file.close();
+	if (!file) {
+		SpillFail(temporary);
+	}
+	error_code error;
+	filesystem::rename(temporary, path, error);
+	if (error) {
+		SpillFail(path, error);
+	}
+}
+
+// Loads the checkpoint into header and dp if it was written for the same
+// instance and mode and its spill file still holds everything it refers to.
+template <typename Cell>
+bool ReadCheckpoint(const string& path, const string& spillPath,
+		const CheckpointHeader& expected, CheckpointHeader& header,
+		vector<Cell>& dp) {
+	ifstream file(path, ios::binary);
+	if (!file || !file.read((char*)&header, sizeof(header))) {
+		return false;
+	}
+	if (header.magic != expected.magic ||
+			header.instanceHash != expected.instanceHash ||
+			header.cellSize != expected.cellSize ||
+			header.buildSolution != expected.buildSolution) {
+		return false;
+	}
+	error_code error;
+	uintmax_t spillBytes = filesystem::file_size(spillPath, error);
+	if (header.spillWords > 0 &&
+			(error || spillBytes < header.spillWords * sizeof(uint64_t))) {
+		return false;
+	}
+	return (bool)file.read((char*)dp.data(), (header.profitSum + 1) * sizeof(Cell));
+}
+
+template <typename Cell, bool BuildSolution>
+long long OutOfCoreDynamicForProfitsKernel(long long n, long long g,
+		const vector<Object>& objects, long long maxProfitSum,
+		const string& spillPath, long long checkpointEvery, vector<int>& out) {
+	const Cell inf = (Cell)g + 1;
+	vector<Cell> dp(maxProfitSum + 1, inf);
+	dp[0] = 0;
+	string checkpointPath = spillPath + ".ckpt";
+
+	const CheckpointHeader fresh = {CHECKPOINT_MAGIC,
+			InstanceHash(n, g, objects), sizeof(Cell), BuildSolution, 1, 0, 0};
+	CheckpointHeader header;
+	if (!ReadCheckpoint(checkpointPath, spillPath, fresh, header, dp)) {
+		header = fresh;
+		fill(dp.begin(), dp.end(), inf);
+		dp[0] = 0;
+	}
+
+	SpillWriter writer(spillPath, BuildSolution ? header.spillWords : 0);
+	vector<uint64_t> row;
+	if constexpr (BuildSolution) {
+		row.assign(maxProfitSum / 64 + 1, 0);
+	}
+
+	long long profitSum = header.profitSum;
+	for (long long i = header.nextItem; i <= n; ++i) {
+		if (objects[i].weight <= g) {
+			long long profit = objects[i].profit;
+			Cell weight = (Cell)objects[i].weight;
+			profitSum += profit;
+			for (long long j = profitSum; j >= profit; --j) {
+				Cell candidate = dp[j - profit] + weight;
+				if (candidate < dp[j]) {
+					dp[j] = candidate;
+					if constexpr (BuildSolution) {
+						row[j / 64] |= 1ULL << (j % 64);
+					}
+				}
+			}
+			if constexpr (BuildSolution) {
+				SpillRecord(writer, row, profit / 64, profitSum / 64);
+			}
+		} else if constexpr (BuildSolution) {
+			SpillRecord(writer, row, 1, 0);
+		}
+
+		if (i % checkpointEvery == 0 && i < n) {
+			writer.Flush();
+			header.nextItem = i + 1;
+			header.profitSum = profitSum;
+			header.spillWords = writer.words;
+			WriteCheckpoint(checkpointPath, header, dp);
+		}
+	}
+	writer.Flush();
+
+	long long ans = profitSum;
+	while (ans > 0 && dp[ans] > (Cell)g) {
+		--ans;
+	}
+
+	if constexpr (BuildSolution) {
+		SpillReader reader(spillPath, writer.words);
+		long long j = ans;
+		for (long long i = n; i >= 1; --i) {
+			if (reader.PopBit(j)) {
+				out.push_back(i - 1);
+				j -= objects[i].profit;
+			}
+		}
+	}
+
+	writer.file.close();
+	error_code error;
+	if (!filesystem::remove(spillPath, error) && error) {
+		SpillFail(spillPath, error);
+	}
+	if (!filesystem::remove(checkpointPath, error) && error) {
+		SpillFail(checkpointPath, error);
+	}
+	return ans;
+}
+
+// Out of core DynamicForProfits. The decision bits go to spillPath and the
+// row is checkpointed every checkpointEvery objects.
+template <bool BuildSolution>
+long long OutOfCoreDynamicForProfits(long long n, long long g,
+		const vector<Object>& objects, const string& spillPath,
+		vector<int>& out, long long checkpointEvery = 256) {
+	long long maxProfitSum = 0;
+	for (long long i = 1; i <= n; i++) {
+		if (objects[i].weight <= g) {
+			maxProfitSum += objects[i].profit;
+		}
+	}
+
+	if (2 * g + 1 <= INT32_MAX) {
+		return OutOfCoreDynamicForProfitsKernel<int32_t, BuildSolution>(n, g,
+				objects, maxProfitSum, spillPath, checkpointEvery, out);
+	}
+	return OutOfCoreDynamicForProfitsKernel<int64_t, BuildSolution>(n, g,
+			objects, maxProfitSum, spillPath, checkpointEvery, out);
+}
+
+#endif // OUTOFCORE_H